@@ -0,0 +1,29 @@
+/*  io_engine.h ― pluggable I/O engine (plain syscalls or io_uring)
+ *
+ *  Build with `make IO_URING=1` to compile the io_uring backend in; set
+ *  ACADEMIA_IO=sync in the environment to force the plain syscalls at run
+ *  time.  Kernels without io_uring fall back to the plain paths silently.
+ */
+#ifndef IO_ENGINE_H
+#define IO_ENGINE_H
+
+#include <sys/types.h>
+
+/* 1 if the calling thread is using io_uring, 0 otherwise */
+int     io_engine_uring(void);
+
+/* socket I/O — in io_uring mode sends are batched until the next receive
+ * or io_close(), so every socket must be closed with io_close().
+ * Read-ahead belongs to the thread, not the socket: using io_recv/io_send
+ * on a second socket discards bytes received on the first but not yet
+ * returned.  Serve one socket per thread at a time.                      */
+ssize_t io_recv(int fd, void *buf, size_t len);
+ssize_t io_send(int fd, const void *buf, size_t len);
+int     io_close(int fd);
+
+/* data-file I/O — return -1 (errno ENOSYS) when io_uring is not in use so
+ * the caller can take its own plain read()/write() path                   */
+ssize_t io_read_at(int fd, void *buf, size_t len, off_t off);
+int     io_write_lines(int fd, char *const *ln, int n);   /* no fsync */
+
+#endif
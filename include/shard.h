@@ -0,0 +1,28 @@
+/*  shard.h ― hash partitioning of the student / faculty / course files
+ *
+ *  With N shards, rows of e.g. data/students.txt live in data/students.txt.0
+ *  … data/students.txt.<N-1>, picked by a hash of the row key (field 0).
+ *  N = 1 (or no SHARD_CONF) means the plain, unsharded file.  N is read
+ *  from SHARD_CONF at start-up and changed offline with the reshard tool.
+ *
+ *  SHARD_CONF also holds a generation G.  The names above are generation
+ *  0; every reshard writes generation G+1 as data/students.txt.g<G+1>.<i>,
+ *  so the old and new layouts never share a file and rewriting SHARD_CONF
+ *  is the only step that switches between them.
+ */
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stddef.h>
+
+#ifndef SHARD_CONF
+#define SHARD_CONF "data/shards.conf"
+#endif
+#define MAX_SHARDS 256
+
+int  shard_load_conf(int *gen);                   /* 1 … MAX_SHARDS     */
+int  shard_save_conf(int n, int gen);             /* 0 ok, -1 errno     */
+int  shard_of(const char *key, int n);            /* key ends at | or \0 */
+void shard_path(const char *base, int i, int n, int gen, char *out, size_t sz);
+
+#endif
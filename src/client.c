@@ -7,6 +7,7 @@
 #include <sys/socket.h>
 #include "../include/common.h"
 #include "../include/utils.h"
+#include "../include/io_engine.h"
 static int is_prompt_line(const char *s)
 {
     size_t i = strlen(s);
@@ -42,6 +43,6 @@ int main(void)
             send_line(sockfd, sendbuf);
         }
     }
-    close(sockfd);
+    io_close(sockfd);
     return 0;
 }
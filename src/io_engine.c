@@ -0,0 +1,408 @@
+/*  io_engine.c ― plain-syscall and io_uring I/O engines
+ *
+ *  Every thread owns a small ring (created on first use, torn down when the
+ *  thread exits) with
+ *    ▸ two registered buffers: socket read-ahead and pending sends
+ *    ▸ a one-slot fixed-file table holding the socket the thread serves
+ *  Pending sends are linked in front of the next receive so one prompt +
+ *  answer round-trip costs a single io_uring_enter().  Data files are opened
+ *  per request, so they are neither registered nor copied: load() reads
+ *  straight into its buffer, save() becomes a chain of linked writevs.  Like
+ *  the plain write() path, saves are not synced to disk.
+ */
+#include "io_engine.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#ifndef USE_IO_URING
+
+int io_engine_uring(void) { return 0; }
+
+ssize_t io_recv(int fd, void *buf, size_t len) { return recv(fd, buf, len, 0); }
+ssize_t io_send(int fd, const void *buf, size_t len) { return send(fd, buf, len, 0); }
+int     io_close(int fd) { return close(fd); }
+
+ssize_t io_read_at(int fd, void *buf, size_t len, off_t off)
+{
+    (void)fd; (void)buf; (void)len; (void)off;
+    errno = ENOSYS; return -1;
+}
+
+int io_write_lines(int fd, char *const *ln, int n)
+{
+    (void)fd; (void)ln; (void)n;
+    errno = ENOSYS; return -1;
+}
+
+#else /* ───────────────────────── io_uring ───────────────────────── */
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#define RING_ENTRIES 64
+#define RBUF_SZ      4096              /* registered buffer 0: read-ahead   */
+#define SBUF_SZ      4096              /* registered buffer 1: send batch   */
+#define IOV_PER_SQE  1024              /* UIO_MAXIOV                         */
+
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array, sq_entries, tail;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map; size_t sq_sz, cq_sz, sqe_sz;
+
+    int   sock, fixed;                 /* socket in slot 0; slot usable?    */
+    char *rbuf; size_t rpos, rlen;
+    char *sbuf; size_t slen;
+} Ring;
+
+static int            engine = -1;     /* -1 unknown, 0 sync, 1 uring       */
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_key_t  key;
+static __thread Ring *tls;
+static __thread int   tls_failed;
+
+static int sys_setup(unsigned n, struct io_uring_params *p)
+{ return (int)syscall(__NR_io_uring_setup, n, p); }
+
+static int sys_enter(int fd, unsigned sub, unsigned wait, unsigned flags)
+{ return (int)syscall(__NR_io_uring_enter, fd, sub, wait, flags, NULL, 0); }
+
+static int sys_register(int fd, unsigned op, void *arg, unsigned n)
+{ return (int)syscall(__NR_io_uring_register, fd, op, arg, n); }
+
+static void ring_free(Ring *r)
+{
+    if (r->sqes)   munmap(r->sqes, r->sqe_sz);
+    if (r->cq_map && r->cq_map != r->sq_map) munmap(r->cq_map, r->cq_sz);
+    if (r->sq_map) munmap(r->sq_map, r->sq_sz);
+    if (r->fd >= 0) close(r->fd);
+    free(r->rbuf);                     /* sbuf lives in the same block      */
+    free(r);
+}
+
+static void ring_dtor(void *p) { ring_free(p); }
+
+static void engine_init(void)
+{
+    const char *e = getenv("ACADEMIA_IO");
+    engine = (e && !strcmp(e, "sync")) ? 0 : 1;
+    pthread_key_create(&key, ring_dtor);
+}
+
+static Ring *ring_new(void)
+{
+    Ring *r = calloc(1, sizeof *r);
+    if (!r) return NULL;
+    r->fd = -1; r->sock = -1;
+
+    struct io_uring_params p; memset(&p, 0, sizeof p);
+    if ((r->fd = sys_setup(RING_ENTRIES, &p)) < 0) {
+        if (errno == ENOSYS || errno == EPERM) engine = 0;  /* never again */
+        goto fail;
+    }
+
+    r->sq_sz  = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_sz  = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->sqe_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    if ((p.features & IORING_FEAT_SINGLE_MMAP) && r->cq_sz > r->sq_sz)
+        r->sq_sz = r->cq_sz;
+
+    r->sq_map = mmap(NULL, r->sq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                     r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_map == MAP_FAILED) { r->sq_map = NULL; goto fail; }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) r->cq_map = r->sq_map;
+    else {
+        r->cq_map = mmap(NULL, r->cq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                         r->fd, IORING_OFF_CQ_RING);
+        if (r->cq_map == MAP_FAILED) { r->cq_map = NULL; goto fail; }
+    }
+    r->sqes = mmap(NULL, r->sqe_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                   r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) { r->sqes = NULL; goto fail; }
+
+    char *sq = r->sq_map, *cq = r->cq_map;
+    r->sq_head  = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head  = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->sq_entries = p.sq_entries;
+    r->tail     = *r->sq_tail;
+
+    /* registered buffers are mandatory, the fixed-file slot is a bonus */
+    if (posix_memalign((void **)&r->rbuf, 4096, RBUF_SZ + SBUF_SZ)) {
+        r->rbuf = NULL; goto fail;
+    }
+    r->sbuf = r->rbuf + RBUF_SZ;
+    struct iovec iov[2] = { { r->rbuf, RBUF_SZ }, { r->sbuf, SBUF_SZ } };
+    if (sys_register(r->fd, IORING_REGISTER_BUFFERS, iov, 2) < 0) goto fail;
+
+    int none = -1;
+    r->fixed = sys_register(r->fd, IORING_REGISTER_FILES, &none, 1) == 0;
+    return r;
+
+fail:
+    ring_free(r);
+    return NULL;
+}
+
+/* per-thread ring, or NULL → caller uses plain syscalls */
+static Ring *ring_get(void)
+{
+    pthread_once(&once, engine_init);
+    if (tls) return tls;
+    if (!engine || tls_failed) return NULL;
+    if (!(tls = ring_new())) { tls_failed = 1; return NULL; }
+    pthread_setspecific(key, tls);
+    return tls;
+}
+
+int io_engine_uring(void) { return ring_get() != NULL; }
+
+/* io_uring_enter() failed with SQEs in flight: their completions would be
+ * taken for those of a later call, so close the ring (the kernel cancels
+ * what is left) and serve this thread with plain syscalls from now on   */
+static void ring_drop(Ring *r)
+{
+    int e = errno;
+    tls = NULL; tls_failed = 1;
+    pthread_setspecific(key, NULL);
+    ring_free(r);
+    errno = e;
+}
+
+static struct io_uring_sqe *sqe_get(Ring *r)
+{
+    unsigned idx = r->tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof *sqe);
+    r->sq_array[idx] = idx;
+    r->tail++;
+    return sqe;
+}
+
+/* submit everything queued and reap n completions; res[user_data] = result.
+ * -1 means the ring is gone (ring_drop) and r must not be touched again  */
+static int submit_wait(Ring *r, unsigned n, int *res)
+{
+    __atomic_store_n(r->sq_tail, r->tail, __ATOMIC_RELEASE);
+
+    unsigned todo = n, got = 0;
+    while (got < n) {
+        int rc = sys_enter(r->fd, todo, n - got, IORING_ENTER_GETEVENTS);
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            ring_drop(r);
+            return -1;
+        }
+        todo -= (unsigned)rc > todo ? todo : (unsigned)rc;
+
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head, ++got) {
+            struct io_uring_cqe *c = &r->cqes[head & *r->cq_mask];
+            if (c->user_data < n) res[c->user_data] = c->res;
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+/* point fixed slot 0 at fd (or at nothing, fd = -1); unread read-ahead
+ * of the previous socket is dropped — one socket per thread, see header */
+static void slot_set(Ring *r, int fd)
+{
+    if (r->fixed) {
+        struct io_uring_files_update up = { .offset = 0, .fds = (unsigned long)&fd };
+        if (sys_register(r->fd, IORING_REGISTER_FILES_UPDATE, &up, 1) != 1)
+            r->fixed = 0;
+    }
+    r->sock = fd;
+    r->rpos = r->rlen = 0;
+}
+
+static void sqe_sock(Ring *r, struct io_uring_sqe *sqe, int op, int buf_index,
+                     char *addr, size_t len)
+{
+    sqe->opcode    = op;
+    sqe->addr      = (unsigned long)addr;
+    sqe->len       = (unsigned)len;
+    sqe->buf_index = buf_index;
+    if (r->fixed) { sqe->fd = 0; sqe->flags = IOSQE_FIXED_FILE; }
+    else            sqe->fd = r->sock;
+}
+
+/* send pending bytes, optionally linked in front of one read-ahead refill;
+ * returns bytes read (0 = EOF), or 0 when !want_read, or -1 on error       */
+static ssize_t roundtrip(Ring *r, int want_read)
+{
+    for (;;) {
+        unsigned n = 0; int res[2] = { 0, 0 }, w = -1, rd = -1;
+        if (r->slen) {
+            struct io_uring_sqe *s = sqe_get(r);
+            sqe_sock(r, s, IORING_OP_WRITE_FIXED, 1, r->sbuf, r->slen);
+            if (want_read) s->flags |= IOSQE_IO_LINK;
+            s->user_data = w = n++;
+        }
+        if (want_read) {
+            struct io_uring_sqe *s = sqe_get(r);
+            sqe_sock(r, s, IORING_OP_READ_FIXED, 0, r->rbuf, RBUF_SZ);
+            s->user_data = rd = n++;
+        }
+        if (!n) return 0;
+        if (submit_wait(r, n, res) < 0) return -1;
+
+        if (w >= 0) {
+            if (res[w] < 0 && res[w] != -EINTR && res[w] != -EAGAIN) {
+                errno = -res[w]; r->slen = 0; return -1;
+            }
+            if (res[w] > 0) {
+                r->slen -= (size_t)res[w];
+                memmove(r->sbuf, r->sbuf + res[w], r->slen);
+            }
+        }
+        if (rd < 0) { if (r->slen) continue; return 0; }
+        if (res[rd] == -ECANCELED || res[rd] == -EINTR || res[rd] == -EAGAIN)
+            continue;                  /* short write broke the link: retry */
+        if (res[rd] < 0) { errno = -res[rd]; return -1; }
+        r->rpos = 0; r->rlen = (size_t)res[rd];
+        return res[rd];
+    }
+}
+
+/* flush sends to the current socket, then serve fd; -1 if the ring died */
+static int sock_switch(Ring *r, int fd)
+{
+    roundtrip(r, 0);
+    if (tls != r) return -1;
+    slot_set(r, fd);
+    return 0;
+}
+
+ssize_t io_recv(int fd, void *buf, size_t len)
+{
+    Ring *r = ring_get();
+    if (!r || (r->sock != fd && sock_switch(r, fd) < 0))
+        return recv(fd, buf, len, 0);
+
+    if (r->rpos == r->rlen) {
+        ssize_t n = roundtrip(r, 1);
+        if (n <= 0) return n;
+    }
+    size_t k = r->rlen - r->rpos; if (k > len) k = len;
+    memcpy(buf, r->rbuf + r->rpos, k);
+    r->rpos += k;
+    return (ssize_t)k;
+}
+
+ssize_t io_send(int fd, const void *buf, size_t len)
+{
+    Ring *r = ring_get();
+    if (!r || (r->sock != fd && sock_switch(r, fd) < 0))
+        return send(fd, buf, len, 0);
+
+    const char *p = buf; size_t left = len;
+    while (left) {
+        if (r->slen == SBUF_SZ && roundtrip(r, 0) < 0) return -1;
+        size_t k = SBUF_SZ - r->slen; if (k > left) k = left;
+        memcpy(r->sbuf + r->slen, p, k);
+        r->slen += k; p += k; left -= k;
+    }
+    return (ssize_t)len;
+}
+
+int io_close(int fd)
+{
+    Ring *r = tls;
+    if (r && r->sock == fd)
+        sock_switch(r, -1);            /* drop the ring's socket reference  */
+    return close(fd);
+}
+
+ssize_t io_read_at(int fd, void *buf, size_t len, off_t off)
+{
+    Ring *r = ring_get();
+    if (!r) { errno = ENOSYS; return -1; }
+
+    size_t done = 0;
+    while (done < len) {
+        int res = 0;
+        struct io_uring_sqe *s = sqe_get(r);
+        s->opcode = IORING_OP_READ;
+        s->fd     = fd;
+        s->addr   = (unsigned long)((char *)buf + done);
+        s->len    = (unsigned)(len - done);
+        s->off    = (unsigned long long)(off + (off_t)done);
+        if (submit_wait(r, 1, &res) < 0) return -1;
+        if (res == -EINTR || res == -EAGAIN) continue;
+        if (res < 0) { errno = -res; return -1; }
+        if (res == 0) break;
+        done += (size_t)res;
+    }
+    return (ssize_t)done;
+}
+
+/* rewrite the file as ln[0]\n ln[1]\n … with linked writev SQEs */
+int io_write_lines(int fd, char *const *ln, int n)
+{
+    Ring *r = ring_get();
+    if (!r) { errno = ENOSYS; return -1; }
+
+    struct iovec *iov = malloc(sizeof *iov * (2 * (size_t)n + 1));
+    if (!iov) return -1;
+    off_t total = 0;
+    for (int i = 0; i < n; ++i) {
+        iov[2*i]     = (struct iovec){ ln[i], strlen(ln[i]) };
+        iov[2*i + 1] = (struct iovec){ "\n", 1 };
+        total += (off_t)iov[2*i].iov_len + 1;
+    }
+    if (ftruncate(fd, total) < 0) { free(iov); return -1; }
+
+    int niov = 2 * n, ok = 1;
+    int   *res  = malloc(sizeof *res  * r->sq_entries);
+    off_t *want = malloc(sizeof *want * r->sq_entries);
+    if (!res || !want) { free(res); free(want); free(iov); return -1; }
+    int i = 0; off_t off = 0;
+    do {                                /* one round per ring-full of SQEs */
+        unsigned q = 0;
+        while (i < niov && q < r->sq_entries) {
+            int cnt = niov - i < IOV_PER_SQE ? niov - i : IOV_PER_SQE;
+            off_t bytes = 0;
+            for (int j = 0; j < cnt; ++j) bytes += (off_t)iov[i + j].iov_len;
+            struct io_uring_sqe *s = sqe_get(r);
+            s->opcode    = IORING_OP_WRITEV;
+            s->fd        = fd;
+            s->addr      = (unsigned long)&iov[i];
+            s->len       = (unsigned)cnt;
+            s->off       = (unsigned long long)off;
+            s->flags     = IOSQE_IO_LINK;
+            s->user_data = q;
+            want[q++] = bytes;
+            i += cnt; off += bytes;
+        }
+        if (!q) break;                  /* empty file: ftruncate did it all */
+        r->sqes[(r->tail - 1) & *r->sq_mask].flags &= ~IOSQE_IO_LINK;
+        if (submit_wait(r, q, res) < 0) { ok = 0; break; }
+        for (unsigned k = 0; k < q; ++k)
+            if (res[k] != want[k]) ok = 0;
+    } while (ok && i < niov);
+
+    free(want);
+    free(res);
+    free(iov);
+    if (!ok) { errno = EIO; return -1; }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,280 @@
+/*  microbench.c ― timings for the server's storage and parsing primitives
+ *
+ *  Build + run:  make microbench [BENCHFLAGS="-c -r 100000"]
+ *
+ *  server.c is compiled straight into this file so the real (static)
+ *  load(), save(), find_row(), split_line() and list_remove() are measured.
+ *
+ *    -c        CSV output (one row per benchmark, for regression tracking)
+ *    -r rows   largest synthetic file, 10^3 … rows   (default 1000000)
+ *    -p procs  lock_file()/unlock_file() contenders  (default 4)
+ *    -t ms     time budget per benchmark             (default 200)
+ *    -d dir    scratch directory, kept afterwards    (default mkdtemp)
+ *
+ *  POSIX record locks belong to the process, so lock contention is
+ *  measured with forked workers rather than threads.
+ */
+#define main server_main
+#include "server.c"
+#undef main
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/wait.h>
+
+#ifndef BENCH_VERSION
+#define BENCH_VERSION "unknown"
+#endif
+
+/* ────────────────────── allocation counters ────────────────────── */
+
+extern void *__libc_malloc(size_t);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+extern void  __libc_free(void *);
+
+static uint64_t n_allocs, n_bytes;
+
+static void count(size_t sz)
+{
+    __atomic_add_fetch(&n_allocs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&n_bytes, sz, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t sz)            { count(sz);     return __libc_malloc(sz); }
+void *calloc(size_t n, size_t sz)  { count(n * sz); return __libc_calloc(n, sz); }
+void *realloc(void *p, size_t sz)  { count(sz);     return __libc_realloc(p, sz); }
+void  free(void *p)                { __libc_free(p); }
+
+/* ────────────────────── measurement ────────────────────── */
+
+static struct { uint64_t ns, allocs, bytes, t0, a0, b0; } m;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void m_start(void) { m.a0 = n_allocs; m.b0 = n_bytes; m.t0 = now_ns(); }
+static void m_stop(void)
+{
+    m.ns     += now_ns() - m.t0;
+    m.allocs += n_allocs - m.a0;
+    m.bytes  += n_bytes  - m.b0;
+}
+
+static int      csv;
+static uint64_t budget_ns = 200000000u;
+
+/* fn() brackets its timed section with m_start()/m_stop() (or adds to
+ * m.ns itself), returns #ops                                             */
+static void run(const char *name, long rows, long (*fn)(void *), void *ctx)
+{
+    fn(ctx);                                        /* warm-up */
+    memset(&m, 0, sizeof m);
+    long ops = 0;
+    do ops += fn(ctx); while (m.ns < budget_ns);
+
+    double ns = (double)m.ns / ops, b = (double)m.bytes / ops,
+           a = (double)m.allocs / ops;
+    const char *eng = io_engine_uring() ? "uring" : "sync";
+    if (csv)
+        printf("%s,%s,%s,%ld,%ld,%.1f,%.1f,%.2f\n",
+               BENCH_VERSION, eng, name, rows, ops, ns, b, a);
+    else if (rows)
+        printf("%-22s %9ld %14.1f %12.1f %10.2f\n", name, rows, ns, b, a);
+    else
+        printf("%-22s %9s %14.1f %12.1f %10.2f\n", name, "-", ns, b, a);
+    fflush(stdout);
+}
+
+/* ────────────────────── benchmarks ────────────────────── */
+
+typedef struct { char path[256]; long rows; File f; char key[32]; } FileCtx;
+
+static long b_load(void *p)
+{
+    FileCtx *c = p; File f;
+    m_start(); load(c->path, &f, F_RDLCK); m_stop();
+    release(&f);
+    return 1;
+}
+
+static long b_save(void *p)
+{
+    FileCtx *c = p; File f;
+    load(c->path, &f, F_WRLCK);
+    m_start(); save(&f); m_stop();
+    return 1;
+}
+
+static long b_find_row(void *p)                   /* worst case: last row */
+{
+    FileCtx *c = p;
+    long batch = c->rows >= 100000 ? 1 : 100000 / c->rows;
+    m_start();
+    for (long i = 0; i < batch; ++i)
+        if (find_row(&c->f, c->key, 0) < 0) abort();
+    m_stop();
+    return batch;
+}
+
+static const char *row = "user0004242|pw0004242|1|CS101,EB101,MP222";
+
+static long b_split_line(void *p)
+{
+    (void)p; char *fld[4];
+    m_start();
+    for (int i = 0; i < 10000; ++i)
+        if (split_line(row, fld) != 4) abort();
+    m_stop();
+    return 10000;
+}
+
+static long b_list_remove(void *p)                /* as in student_unenroll */
+{
+    (void)p;
+    static const char *list = "CS101,EB101,MP222,CS102,EB102,MP223,CS103,EB103";
+    char scratch[MAX_LIST], out[MAX_LIST];
+    m_start();
+    for (int i = 0; i < 10000; ++i) {
+        strcpy(scratch, list);
+        if (!list_remove(scratch, "MP223", out)) abort();
+    }
+    m_stop();
+    return 10000;
+}
+
+static long b_recv_line(void *p)                  /* over a socketpair */
+{
+    int *sv = p; char buf[MAX_LINE];
+    enum { K = 256 };
+    for (int i = 0; i < K; ++i) {
+        char ln[64]; int n = snprintf(ln, sizeof ln, "%s\n", row);
+        if (send(sv[1], ln, (size_t)n, 0) != n) abort();
+    }
+    m_start();
+    for (int i = 0; i < K; ++i)
+        if (recv_line(sv[0], buf, sizeof buf) <= 0) abort();
+    m_stop();
+    return K;
+}
+
+typedef struct { char path[256]; int procs; } LockCtx;
+
+/* workers time themselves once the start pipe is closed; the slowest
+ * worker's time is the section's, so fork()/exit are not measured        */
+static long b_lock(void *p)
+{
+    LockCtx *c = p;
+    enum { ITERS = 2000 };
+    int go[2], res[2];
+    if (pipe(go) < 0 || pipe(res) < 0) { perror("pipe"); exit(1); }
+    for (int w = 0; w < c->procs; ++w) {
+        if (fork() == 0) {
+            close(go[1]); close(res[0]);
+            int fd = open(c->path, O_RDWR | O_CREAT, 0666);
+            char b;
+            if (read(go[0], &b, 1) != 0) _exit(1);          /* EOF = start */
+            uint64_t t0 = now_ns();
+            for (int i = 0; i < ITERS; ++i) {
+                lock_file(fd, F_WRLCK);
+                unlock_file(fd);
+            }
+            uint64_t dt = now_ns() - t0;
+            _exit(write(res[1], &dt, sizeof dt) == sizeof dt ? 0 : 1);
+        }
+    }
+    close(go[0]); close(res[1]);
+    close(go[1]);                                   /* release the workers */
+    uint64_t dt, slowest = 0;
+    int done = 0;
+    while (read(res[0], &dt, sizeof dt) == sizeof dt) {
+        if (dt > slowest) slowest = dt;
+        ++done;
+    }
+    close(res[0]);
+    while (wait(NULL) > 0) ;
+    if (done != c->procs) { fprintf(stderr, "lock worker failed\n"); exit(1); }
+    m.ns += slowest;
+    return (long)c->procs * ITERS;
+}
+
+/* ────────────────────── synthetic data ────────────────────── */
+
+static void make_file(FileCtx *c, const char *dir, long rows)
+{
+    snprintf(c->path, sizeof c->path, "%s/students-%ld.txt", dir, rows);
+    c->rows = rows;
+    FILE *fp = fopen(c->path, "w");
+    if (!fp) { perror(c->path); exit(1); }
+    for (long i = 0; i < rows; ++i)
+        fprintf(fp, "user%07ld|pw%07ld|1|CS101,EB101,MP222\n", i, i);
+    fclose(fp);
+    snprintf(c->key, sizeof c->key, "user%07ld", rows - 1);
+}
+
+int main(int argc, char **argv)
+{
+    long maxrows = 1000000, ms = 200; int procs = 4, opt, bad = 0;
+    char dir[256] = "";
+    int own_dir = 0;                               /* made by mkdtemp */
+    while ((opt = getopt(argc, argv, "cr:p:t:d:")) != -1) {
+        if      (opt == 'c') csv = 1;
+        else if (opt == 'r') maxrows = atol(optarg);
+        else if (opt == 'p') procs = atoi(optarg);
+        else if (opt == 't') ms = atol(optarg);
+        else if (opt == 'd') snprintf(dir, sizeof dir, "%s", optarg);
+        else bad = 1;
+    }
+    if (bad || maxrows < 1 || procs < 1 || ms < 1) {  /* 0 ops would never end */
+        fprintf(stderr, "usage: %s [-c] [-r rows>=1] [-p procs>=1] [-t ms>=1] [-d dir]\n",
+                argv[0]);
+        return 2;
+    }
+    budget_ns = (uint64_t)ms * 1000000u;
+    if (!*dir) {
+        strcpy(dir, "/tmp/academia-bench.XXXXXX");
+        if (!mkdtemp(dir)) { perror("mkdtemp"); return 1; }
+        own_dir = 1;
+    }
+
+    if (csv) puts("version,engine,benchmark,rows,ops,ns_per_op,bytes_per_op,allocs_per_op");
+    else {
+        printf("academia microbench %s  (engine: %s)\n", BENCH_VERSION,
+               io_engine_uring() ? "uring" : "sync");
+        printf("%-22s %9s %14s %12s %10s\n",
+               "benchmark", "rows", "ns/op", "B/op", "allocs/op");
+    }
+
+    for (long rows = 1000; rows <= maxrows; rows *= 10) {
+        FileCtx c; make_file(&c, dir, rows);
+        run("load", rows, b_load, &c);
+        run("save", rows, b_save, &c);
+        load(c.path, &c.f, F_RDLCK);
+        run("find_row", rows, b_find_row, &c);
+        release(&c.f);
+        unlink(c.path);
+    }
+
+    run("split_line", 0, b_split_line, NULL);
+    run("list_remove", 0, b_list_remove, NULL);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) { perror("socketpair"); return 1; }
+    run("recv_line", 0, b_recv_line, sv);
+    io_close(sv[0]); close(sv[1]);
+
+    LockCtx lc; snprintf(lc.path, sizeof lc.path, "%s/lock.txt", dir);
+    char name[32];
+    for (int n = 1; ; n *= 2) {                    /* 1, 2, 4 … procs */
+        lc.procs = n < procs ? n : procs;
+        snprintf(name, sizeof name, "lock_unlock/%dp", lc.procs);
+        run(name, 0, b_lock, &lc);
+        if (lc.procs == procs) break;
+    }
+    unlink(lc.path);
+    if (own_dir) rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* ---------- src/reshard.c ----------------------------------- */
+/*  Offline re-partitioning of the student / faculty / course files.
+ *
+ *    ./reshard        show the current shard count and rows per shard
+ *    ./reshard N      rewrite every store into N shards (1 = plain files)
+ *
+ *  The server must be stopped.  The new shards are written as the next
+ *  generation (see shard.h), whose file names the current layout never
+ *  uses, and synced.  Rewriting SHARD_CONF then switches layouts in one
+ *  rename; only after that are the old generation's files removed.  A
+ *  run that fails before the switch leaves the data as it was.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "../include/common.h"
+#include "../include/shard.h"
+
+static const char *stores[] = { STUDENT_FILE, FACULTY_FILE, COURSE_FILE };
+#define NSTORES (int)(sizeof stores / sizeof *stores)
+
+typedef struct { char **ln; int n, max; } Lines;
+
+static void push(Lines *l, const char *s)
+{
+    if (l->n == l->max) {
+        l->max = l->max ? l->max * 2 : 256;
+        l->ln  = realloc(l->ln, l->max * sizeof *l->ln);
+    }
+    l->ln[l->n++] = strdup(s);
+}
+
+/* every non-blank row of a store, in the layout given by `n` and `gen`;
+ * -1 if any existing shard cannot be read (nothing may be rewritten then) */
+static int read_store(const char *base, int n, int gen, Lines *out)
+{
+    char path[256], buf[4096];
+    for (int i = 0; i < n; ++i) {
+        shard_path(base, i, n, gen, path, sizeof path);
+        FILE *fp = fopen(path, "r");
+        if (!fp) {
+            if (errno == ENOENT) continue;       /* empty shard never made */
+            perror(path); return -1;
+        }
+        while (fgets(buf, sizeof buf, fp)) {
+            buf[strcspn(buf, "\r\n")] = '\0';
+            if (*buf) push(out, buf);
+        }
+        int bad = ferror(fp);
+        fclose(fp);
+        if (bad) { fprintf(stderr, "%s: read error\n", path); return -1; }
+    }
+    return 0;
+}
+
+/* shard a row goes to — comments stay in shard 0 */
+static int row_shard(const char *s, int n)
+{
+    return (*s == '#') ? 0 : shard_of(s, n);
+}
+
+/* files of generation `gen` left behind by an earlier run that failed
+ * before switching; the live layout is never of that generation          */
+static void clear_store(const char *base, int gen)
+{
+    char path[256];
+    for (int i = 0; i < MAX_SHARDS; ++i) {
+        shard_path(base, i, MAX_SHARDS, gen, path, sizeof path);
+        unlink(path);
+    }
+}
+
+/* the new generation, synced so the SHARD_CONF switch cannot outrun it */
+static int write_store(const char *base, int n, int gen, const Lines *l)
+{
+    char path[256];
+    FILE *fp[MAX_SHARDS];
+    for (int i = 0; i < n; ++i) {
+        shard_path(base, i, n, gen, path, sizeof path);
+        if (!(fp[i] = fopen(path, "w"))) { perror(path); return -1; }
+    }
+    for (int j = 0; j < l->n; ++j)
+        fprintf(fp[row_shard(l->ln[j], n)], "%s\n", l->ln[j]);
+    int rc = 0;
+    for (int i = 0; i < n; ++i) {
+        if (fflush(fp[i]) != 0 || fsync(fileno(fp[i])) != 0) rc = -1;
+        if (fclose(fp[i]) != 0) rc = -1;
+    }
+    if (rc < 0) perror(base);
+    return rc;
+}
+
+/* the old layout, once SHARD_CONF no longer points at it */
+static void prune_store(const char *base, int n, int gen)
+{
+    char path[256];
+    for (int i = 0; i < n; ++i) {
+        shard_path(base, i, n, gen, path, sizeof path);
+        unlink(path);
+    }
+}
+
+static int server_running(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa = { .sin_family = AF_INET,
+                              .sin_addr.s_addr = htonl(0x7f000001),
+                              .sin_port = htons(PORT) };
+    int up = connect(fd, (void*)&sa, sizeof sa) == 0;
+    close(fd);
+    return up;
+}
+
+int main(int argc, char **argv)
+{
+    int gen, old = shard_load_conf(&gen);
+
+    if (argc < 2) {
+        printf("%d shard%s (generation %d)\n", old, old > 1 ? "s" : "", gen);
+        for (int s = 0; s < NSTORES; ++s) {
+            Lines l = {0};
+            if (read_store(stores[s], old, gen, &l) < 0) return 1;
+            int per[MAX_SHARDS] = {0};
+            for (int j = 0; j < l.n; ++j) per[row_shard(l.ln[j], old)]++;
+            printf("%-24s %6d rows :", stores[s], l.n);
+            for (int i = 0; i < old; ++i) printf(" %d", per[i]);
+            putchar('\n');
+        }
+        return 0;
+    }
+
+    int n = atoi(argv[1]);
+    if (n < 1 || n > MAX_SHARDS) {
+        fprintf(stderr, "usage: %s [N]   (1 <= N <= %d)\n", argv[0], MAX_SHARDS);
+        return 2;
+    }
+    if (n == old) { printf("already %d shard%s\n", n, n > 1 ? "s" : ""); return 0; }
+    if (server_running()) {
+        fprintf(stderr, "server is listening on %d - stop it before resharding\n", PORT);
+        return 1;
+    }
+
+    Lines l[NSTORES] = {{0}};
+    for (int s = 0; s < NSTORES; ++s)
+        if (read_store(stores[s], old, gen, &l[s]) < 0) return 1;  /* before any write */
+    for (int s = 0; s < NSTORES; ++s) {
+        clear_store(stores[s], gen + 1);
+        if (write_store(stores[s], n, gen + 1, &l[s]) < 0) return 1;
+    }
+    if (shard_save_conf(n, gen + 1) < 0) { perror(SHARD_CONF); return 1; }
+    for (int s = 0; s < NSTORES; ++s) {
+        prune_store(stores[s], old, gen);
+        printf("%-24s %6d rows : %d -> %d shard%s\n",
+               stores[s], l[s].n, old, n, n > 1 ? "s" : "");
+    }
+    return 0;
+}
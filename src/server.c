@@ -1,20 +1,26 @@
 /*  server.c ― Academia Course-Registration Portal (multi-threaded TCP server)
  *  CS-513  System Software  ▪  IIIT-B
  *
- *  Build:  gcc -Wall -Iinclude -pthread src/server.c src/utils.c -o server
+ *  Build:  gcc -Wall -Iinclude -pthread src/server.c src/utils.c src/io_engine.c \
+ *              src/shard.c -o server
+ *          (make IO_URING=1 adds the io_uring engine, see io_engine.h)
  *
  *  Highlights
  *  ──────────
  *  ▸ crash-safe record editing (never modify a line in-place after strtok)
  *  ▸ no double-frees or leaks, no hidden NULs in files
  *  ▸ menus tolerate stray <Enter> presses; blank lines are skipped quietly
+ *  ▸ data files hash-sharded by key (shard.h); edits lock one shard only
  */
 
  #include <stdio.h>
  #include <stdlib.h>
  #include <string.h>
+ #include <stdarg.h>
  #include <unistd.h>
  #include <pthread.h>
+ #include <stdint.h>
+ #include <time.h>
  #include <netinet/in.h>
  #include <sys/socket.h>
  #include <sys/stat.h>
@@ -23,6 +29,8 @@
  
  #include "common.h"   /* PORT, STUDENT_FILE, FACULTY_FILE, COURSE_FILE … */
  #include "utils.h"    /* send_line(), recv_line(), lock_file()           */
+ #include "io_engine.h"/* io_read_at(), io_write_lines(), io_close()       */
+ #include "shard.h"    /* shard_of(), shard_path(), MAX_SHARDS            */
  
  #define MAX_FIELD 128
  #define MAX_LINE  1024
@@ -30,11 +38,13 @@
  
  /* ────────────────────── tiny mmap-ish helper ────────────────────── */
  
- typedef struct { int fd; size_t sz; char *buf; char **ln; int n; } File;
+ typedef struct { int fd; size_t sz; char *buf; char **ln; int n;
+                  pthread_rwlock_t *lk; } File;
  
  /* open + (optionally) lock + load whole text file */
  static int load(const char *path, File *f, int lock_type)
  {
+     f->lk = NULL;
      f->fd = open(path, O_RDWR | O_CREAT, 0666);
      if (f->fd < 0) return -1;
      if (lock_file(f->fd, lock_type) < 0) return -1;
@@ -43,7 +53,8 @@
      f->sz = (size_t)st.st_size;
  
      f->buf = malloc(f->sz + 1);
-     if (f->sz) read(f->fd, f->buf, f->sz);
+     if (f->sz && io_read_at(f->fd, f->buf, f->sz, 0) < 0)
+         read(f->fd, f->buf, f->sz);       /* no io_uring → plain read    */
      f->buf[f->sz] = '\0';
  
      f->n  = 0;
@@ -61,14 +72,17 @@
  
  static void save(File *f)                 /* write-back + unlock */
  {
-     lseek(f->fd, 0, SEEK_SET);
-     ftruncate(f->fd, 0);
-     for (int i = 0; i < f->n; ++i) {
-         write(f->fd, f->ln[i], strlen(f->ln[i]));
-         write(f->fd, "\n", 1);
+     if (io_write_lines(f->fd, f->ln, f->n) < 0) {   /* no io_uring */
+         lseek(f->fd, 0, SEEK_SET);
+         ftruncate(f->fd, 0);
+         for (int i = 0; i < f->n; ++i) {
+             write(f->fd, f->ln[i], strlen(f->ln[i]));
+             write(f->fd, "\n", 1);
+         }
      }
      unlock_file(f->fd);
      close(f->fd);
+     if (f->lk) pthread_rwlock_unlock(f->lk);
      free(f->buf);
      free(f->ln);
  }
@@ -77,10 +91,104 @@
  {
      unlock_file(f->fd);
      close(f->fd);
+     if (f->lk) pthread_rwlock_unlock(f->lk);
      free(f->buf);
      free(f->ln);
  }
  
+ /* ────────────────────── sharded stores ────────────────────── */
+ 
+ static int nshards = 1, shard_gen = 0;   /* from SHARD_CONF, set in main() */
+ 
+ /* fcntl locks only keep other processes out, so each shard of the three
+  * stores also has an in-process rwlock; threads on different shards never
+  * wait for each other.  Nobody holds two shards of one store for writing. */
+ static pthread_rwlock_t shard_lk[3][MAX_SHARDS];
+ static pthread_once_t   shard_once = PTHREAD_ONCE_INIT;
+ 
+ static void shard_lk_init(void)
+ {
+     for (int i = 0; i < 3; ++i)
+         for (int j = 0; j < MAX_SHARDS; ++j) pthread_rwlock_init(&shard_lk[i][j], NULL);
+ }
+ 
+ static pthread_rwlock_t *shard_lock(const char *base, int i)
+ {
+     pthread_once(&shard_once, shard_lk_init);
+     if (!strcmp(base, STUDENT_FILE)) return &shard_lk[0][i];
+     if (!strcmp(base, FACULTY_FILE)) return &shard_lk[1][i];
+     if (!strcmp(base, COURSE_FILE))  return &shard_lk[2][i];
+     return NULL;
+ }
+ 
+ /* load() one shard of a store under both locks */
+ static int load_at(const char *base, int i, File *f, int lock_type)
+ {
+     char path[256]; shard_path(base, i, nshards, shard_gen, path, sizeof path);
+     pthread_rwlock_t *lk = shard_lock(base, i);
+     if (lk) {
+         if (lock_type == F_WRLCK) pthread_rwlock_wrlock(lk);
+         else                      pthread_rwlock_rdlock(lk);
+     }
+     if (load(path, f, lock_type) < 0) {
+         if (lk) pthread_rwlock_unlock(lk);
+         return -1;
+     }
+     f->lk = lk;
+     return 0;
+ }
+ 
+ /* the shard that holds (or will hold) `key` */
+ static int load_key(const char *base, const char *key, File *f, int lock_type)
+ {
+     return load_at(base, shard_of(key, nshards), f, lock_type);
+ }
+ 
+ /* every shard, read-locked in shard order; NULL on error */
+ static File *load_all(const char *base)
+ {
+     File *fs = malloc(nshards * sizeof *fs);
+     for (int i = 0; i < nshards; ++i)
+         if (load_at(base, i, &fs[i], F_RDLCK) < 0) {
+             while (i--) release(&fs[i]);
+             free(fs);
+             return NULL;
+         }
+     return fs;
+ }
+ 
+ static void release_all(File *fs)
+ {
+     for (int i = 0; i < nshards; ++i) release(&fs[i]);
+     free(fs);
+ }
+ 
+ /* Views render their reply while the shards are locked and send it only
+  * after releasing them: a client that stops reading must not stall the
+  * writers of a whole store.                                              */
+ typedef struct { char *s; size_t len, cap; } Text;
+ 
+ static void text_printf(Text *t, const char *fmt, ...)
+ {
+     va_list ap;
+     va_start(ap, fmt); int k = vsnprintf(NULL, 0, fmt, ap); va_end(ap);
+     if (k < 0) return;
+     if (t->len + k + 1 > t->cap) {
+         size_t cap = t->cap ? t->cap : 4096;
+         while (t->len + k + 1 > cap) cap *= 2;
+         char *p = realloc(t->s, cap); if (!p) return;
+         t->s = p; t->cap = cap;
+     }
+     va_start(ap, fmt); vsnprintf(t->s + t->len, k + 1, fmt, ap); va_end(ap);
+     t->len += k;
+ }
+ 
+ static void text_send(int s, Text *t)     /* send + free */
+ {
+     if (t->s) send_line(s, t->s);
+     free(t->s);
+ }
+ 
  /* ────────────────────── helper utilities ────────────────────── */
  
  /* Split a line into ≤4 fields without altering the original string */
@@ -127,7 +235,243 @@
      return -1;
  }
  
+ /* copy comma-list into out[] minus every `item`; returns 1 if it was there */
+ static int list_remove(char *list, const char *item, char out[MAX_LIST])
+ {
+     int first = 1, had = 0;
+     char *sub, *sv;
+     out[0] = '\0';
+     sub = strtok_r(list, ",", &sv);
+     while (sub) {
+         if (strcmp(sub, item)) {
+             if (!first) strcat(out, ",");
+             strcat(out, sub); first = 0;
+         } else had = 1;
+         sub = strtok_r(NULL, ",", &sv);
+     }
+     return had;
+ }
+ 
+ /* ────────────────────── admission control ────────────────────── */
+ 
+ /* Token buckets keyed by (class, source IP) or (class, role:user), kept in
+  * a fixed open-addressed table.  Each bucket is one 64-bit word
+  * [milli-tokens:32 | last refill ms:32] updated with CAS, so checks never
+  * block.  A full table fails open rather than throttling strangers.     */
+ enum { RL_CONNECT, RL_LOGIN_IP, RL_LOGIN_USER, RL_MUTATE_IP, RL_MUTATE_USER, RL_NCLASS };
+ 
+ static const struct { const char *name; uint32_t burst, per_min; } rl_pol[RL_NCLASS] = {
+     [RL_CONNECT]     = { "connect  / ip",   30, 120 },
+     [RL_LOGIN_IP]    = { "login    / ip",   10,  30 },
+     [RL_LOGIN_USER]  = { "login    / user",  5,  10 },
+     [RL_MUTATE_IP]   = { "mutation / ip",   60, 600 },
+     [RL_MUTATE_USER] = { "mutation / user", 20, 120 },
+ };
+ 
+ #define RL_SLOTS  4096                 /* power of two                    */
+ #define RL_PROBE  8
+ #define RL_IDLE   (10 * 60 * 1000u)    /* ms before a slot may be reused  */
+ 
+ static struct { uint64_t key, st; } rl_tab[RL_SLOTS];
+ static uint64_t rl_hits[RL_NCLASS];    /* throttle events per class       */
+ 
+ static __thread uint32_t peer_ip;      /* source address of this client   */
+ 
+ static uint32_t now_ms(void)
+ {
+     struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+ }
+ 
+ static uint64_t rl_hash(int cls, const void *key, size_t len)
+ {
+     uint64_t h = 1469598103934665603ull ^ (uint64_t)cls;    /* FNV-1a */
+     for (size_t i = 0; i < len; ++i) { h ^= ((const uint8_t*)key)[i]; h *= 1099511628211ull; }
+     return h | 1;                                           /* 0 = free */
+ }
+ 
+ /* 0 → allowed (one token taken unless peeking), else ms until next token */
+ static uint32_t rl_bucket(int cls, const void *key, size_t len, int take)
+ {
+     uint64_t h = rl_hash(cls, key, len);
+     uint32_t now = now_ms(), cap = rl_pol[cls].burst * 1000;
+     uint64_t *st = NULL;
+ 
+     for (int p = 0; p < RL_PROBE && !st; ++p) {
+         size_t i = (h + p) & (RL_SLOTS - 1);
+         uint64_t k = __atomic_load_n(&rl_tab[i].key, __ATOMIC_ACQUIRE);
+         if (k == h) st = &rl_tab[i].st;
+         else if ((k == 0 || now - (uint32_t)__atomic_load_n(&rl_tab[i].st, __ATOMIC_RELAXED) > RL_IDLE)
+                  && __atomic_compare_exchange_n(&rl_tab[i].key, &k, h, 0,
+                                                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+             __atomic_store_n(&rl_tab[i].st, 0, __ATOMIC_RELEASE);   /* full */
+             st = &rl_tab[i].st;
+         }
+     }
+     if (!st) return 0;
+ 
+     uint64_t old = __atomic_load_n(st, __ATOMIC_ACQUIRE), nw;
+     do {
+         uint32_t tok = old ? (uint32_t)(old >> 32) : cap;
+         uint64_t fill = old ? (uint64_t)(now - (uint32_t)old) * rl_pol[cls].per_min / 60 : 0;
+         tok = tok + fill > cap ? cap : tok + (uint32_t)fill;
+         if (tok < 1000) {
+             __atomic_add_fetch(&rl_hits[cls], 1, __ATOMIC_RELAXED);
+             return (uint32_t)((1000 - tok) * 60 / rl_pol[cls].per_min) + 1;
+         }
+         if (!take) return 0;
+         nw = (uint64_t)(tok - 1000) << 32 | now;
+     } while (!__atomic_compare_exchange_n(st, &old, nw, 1,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+     return 0;
+ }
+ 
+ static uint32_t rl_take_ip(int cls) { return rl_bucket(cls, &peer_ip, sizeof peer_ip, 1); }
+ 
+ /* user buckets are keyed "<role>:<name>" so roles never share one */
+ static uint32_t rl_user(int cls, const char *role, const char *u, int take)
+ {
+     char key[MAX_FIELD];
+     int k = snprintf(key, sizeof key, "%s:%s", role, u);
+     if (k >= (int)sizeof key) k = sizeof key - 1;
+     return rl_bucket(cls, key, (size_t)k, take);
+ }
+ 
+ static void send_throttled(int s, uint32_t wait_ms)
+ {
+     char msg[96];
+     snprintf(msg, sizeof msg, "[THROTTLED] Too many requests - retry in %u s\n",
+              (wait_ms + 999) / 1000);
+     send_line(s, msg);
+ }
+ 
+ /* charge a mutating menu action to this IP and user; 1 → refused */
+ static int throttled(int s, const char *role, const char *who)
+ {
+     uint32_t w = rl_take_ip(RL_MUTATE_IP);
+     if (!w) w = rl_user(RL_MUTATE_USER, role, who, 1);
+     if (w) send_throttled(s, w);
+     return w != 0;
+ }
+ 
+ /* ────────────────────── course catalog cache ────────────────────── */
+ 
+ /* The rendered "Browse Catalog" reply lives in memory.  Adding/removing a
+  * course drops it (rebuilt by the next reader); enroll/drop overwrite the
+  * fixed-width seats-left field of one row with the value being saved.
+  * Lock order is always course shard → cat.lk: writers update the cache
+  * while holding their shard's write lock, and a rebuild keeps every shard
+  * read-locked until the new text is swapped in.                          */
+ #define SEAT_W 5
+ 
+ typedef struct { char id[MAX_FIELD]; size_t off; int left; } CatRow;
+ typedef struct { char *txt; size_t len, cap; CatRow *row; int n, max; } Catalog;
+ 
+ static struct {
+     pthread_rwlock_t lk;
+     int     valid;
+     Catalog c;
+ } cat = { .lk = PTHREAD_RWLOCK_INITIALIZER };
+ 
+ static void cat_put(Catalog *c, const char *s, size_t k)
+ {
+     if (c->len + k + 1 > c->cap) {
+         while (c->len + k + 1 > c->cap) c->cap = c->cap ? c->cap * 2 : 4096;
+         c->txt = realloc(c->txt, c->cap);
+     }
+     memcpy(c->txt + c->len, s, k);
+     c->len += k;
+     c->txt[c->len] = '\0';
+ }
+ 
+ static void cat_seats(Catalog *c, size_t off, int left)   /* overwrite in place */
+ {
+     char tmp[SEAT_W + 1];
+     if (left < 0) left = 0;
+     if (left > 99999) left = 99999;
+     snprintf(tmp, sizeof tmp, "%*d", SEAT_W, left);
+     memcpy(c->txt + off, tmp, SEAT_W);
+ }
+ 
+ /* render courses.txt into a fresh catalog and swap it in; -1 on error */
+ static int catalog_build(void)
+ {
+     Catalog c = {0};
+     File *fc = load_all(COURSE_FILE);
+     if (!fc) return -1;
+ 
+     const char *hdr = "\nCourse Catalog  (ID, name, seats left)\n";
+     cat_put(&c, hdr, strlen(hdr));
+     for (int sh = 0; sh < nshards; ++sh)
+     for (int i = 0; i < fc[sh].n; ++i) {
+         if (is_skip_line(fc[sh].ln[i])) continue;
+         char *fld[4]; if (split_line(fc[sh].ln[i], fld) < 4) continue;
+         if (c.n == c.max) {
+             c.max = c.max ? c.max * 2 : 64;
+             c.row = realloc(c.row, c.max * sizeof *c.row);
+         }
+         CatRow *r = &c.row[c.n++];
+         snprintf(r->id, sizeof r->id, "%s", fld[0]);
+         r->left = atoi(fld[2]) - atoi(fld[3]);
+ 
+         char line[MAX_LINE];
+         int k = snprintf(line, sizeof line - SEAT_W - 1, " - %-8s %-24s ", fld[0], fld[1]);
+         if (k > (int)(sizeof line - SEAT_W - 2)) k = sizeof line - SEAT_W - 2;
+         r->off = c.len + k;
+         memset(line + k, ' ', SEAT_W); line[k + SEAT_W] = '\n';
+         cat_put(&c, line, k + SEAT_W + 1);
+         cat_seats(&c, r->off, r->left);
+     }
+     if (!c.n) { c.len = 0; cat_put(&c, "No courses offered\n", 19); }
+ 
+     pthread_rwlock_wrlock(&cat.lk);          /* shards still read-locked */
+     Catalog old = cat.c;
+     cat.c = c; cat.valid = 1;
+     pthread_rwlock_unlock(&cat.lk);
+     release_all(fc);
+     free(old.txt); free(old.row);
+     return 0;
+ }
+ 
+ /* malloc'd copy of the rendered catalog (NULL if the file is unreadable) */
+ static char *catalog_copy(void)
+ {
+     for (;;) {
+         pthread_rwlock_rdlock(&cat.lk);
+         if (cat.valid) {
+             char *out = malloc(cat.c.len + 1);
+             if (out) memcpy(out, cat.c.txt, cat.c.len + 1);
+             pthread_rwlock_unlock(&cat.lk);
+             return out;
+         }
+         pthread_rwlock_unlock(&cat.lk);
+         if (catalog_build() < 0) return NULL;
+     }
+ }
+ 
+ /* course added/removed — caller holds the course shard write lock */
+ static void catalog_invalidate(void)
+ {
+     pthread_rwlock_wrlock(&cat.lk);
+     cat.valid = 0;
+     pthread_rwlock_unlock(&cat.lk);
+ }
+ 
+ /* seats left of one course — caller holds its shard write lock */
+ static void catalog_set(const char *cid, int left)
+ {
+     pthread_rwlock_wrlock(&cat.lk);
+     for (int i = 0; cat.valid && i < cat.c.n; ++i)
+         if (!strcmp(cat.c.row[i].id, cid)) {
+             cat.c.row[i].left = left;
+             cat_seats(&cat.c, cat.c.row[i].off, left);
+             break;
+         }
+     pthread_rwlock_unlock(&cat.lk);
+ }
+ 
  /* ────────────────────── forward decls ────────────────────── */
+ typedef struct { int fd; uint32_t ip; } Conn;   /* accepted client */
  static void *client_thread(void *);
  
  /* admin */
@@ -136,6 +480,7 @@
  static void admin_view(int,const char*,const char*);
  static void admin_toggle(int,int);
  static void admin_setpwd(int,const char*);
+ static void admin_throttle_stats(int);
  
  /* faculty */
  static void faculty_menu(int,const char*);
@@ -150,6 +495,7 @@
  static void student_unenroll(int,const char*);
  static void student_view(int,const char*);
  static void student_change_pwd(int,const char*);
+ static void student_browse(int);
  
  /* ─────────────────────────── main ─────────────────────────── */
  int main(void)
@@ -160,11 +506,18 @@
                                .sin_port = htons(PORT) };
      bind(ls, (void*)&sa, sizeof sa);
      listen(ls, 16);
-     printf(">> Server listening on %d\n", PORT);
+     nshards = shard_load_conf(&shard_gen);
+     printf(">> Server listening on %d (%d shard%s)\n", PORT, nshards, nshards>1?"s":"");
  
      for (;;) {
-         int cs = accept(ls, NULL, NULL);
-         int *p  = malloc(sizeof(int)); *p = cs;
+         struct sockaddr_in peer; socklen_t plen = sizeof peer;
+         int cs = accept(ls, (void*)&peer, &plen);
+         if (cs < 0) continue;
+         peer_ip = peer.sin_addr.s_addr;
+         uint32_t w = rl_take_ip(RL_CONNECT);
+         if (w) { send_throttled(cs, w); io_close(cs); continue; }
+ 
+         Conn *p = malloc(sizeof *p); p->fd = cs; p->ip = peer_ip;
          pthread_t t; pthread_create(&t, NULL, client_thread, p);
          pthread_detach(t);
      }
@@ -177,17 +530,23 @@
      send_line(s,"Admin username:\n"); if (recv_line(s,u,sizeof u)<=0) return 0;
      send_line(s,"Admin password:\n"); if (recv_line(s,p,sizeof p)<=0) return 0;
      u[strcspn(u,"\r\n")] = p[strcspn(p,"\r\n")] = '\0';
-     return !strcmp(u,"admin") && !strcmp(p,"admin123");
+     uint32_t w = rl_user(RL_LOGIN_USER,"admin",u,0);   /* failures only */
+     if (w) { send_throttled(s,w); return -1; }
+     int ok = !strcmp(u,"admin") && !strcmp(p,"admin123");
+     if (!ok) rl_user(RL_LOGIN_USER,"admin",u,1);
+     return ok;
  }
  
- static int auth_file(int s, const char *file, char *who)
+ static int auth_file(int s, const char *file, const char *role, char *who)
  {
      char u[64], p[64];
      send_line(s,"Username:\n"); if (recv_line(s,u,sizeof u)<=0) return 0;
      send_line(s,"Password:\n"); if (recv_line(s,p,sizeof p)<=0) return 0;
      u[strcspn(u,"\r\n")] = p[strcspn(p,"\r\n")] = '\0';
+     uint32_t w = rl_user(RL_LOGIN_USER,role,u,0);      /* failures only */
+     if (w) { send_throttled(s,w); return -1; }
  
-     File f; if (load(file,&f,F_RDLCK)<0) return 0;
+     File f; if (load_key(file,u,&f,F_RDLCK)<0) return 0;
      int ok = 0;
      for (int i = 0; i < f.n; ++i) {
          if (is_skip_line(f.ln[i])) continue;
@@ -197,42 +556,52 @@
          }
      }
      release(&f);
+     if (!ok) rl_user(RL_LOGIN_USER,role,u,1);
      return ok;
  }
  
  /* ────────────────────── per-client thread ────────────────────── */
+ /* auth_*() return 1 ok, 0 bad credentials, -1 throttled (already told) */
  static void *client_thread(void *arg)
  {
-     int s = *(int*)arg; free(arg);
+     Conn c = *(Conn*)arg; free(arg);
+     int s = c.fd; peer_ip = c.ip;
  
      send_line(s,"................Welcome Back to Academia................\n"
                  "Login Type\n"
                  "Enter Your Choice { 1.Admin , 2.Professor , 3.Student }: \n");
  
      int role = recv_choice(s);
-     if (role == -1) { close(s); return NULL; }
+     if (role == -1) { io_close(s); return NULL; }
+     if (role >= 1 && role <= 3) {
+         uint32_t w = rl_take_ip(RL_LOGIN_IP);
+         if (w) { send_throttled(s,w); io_close(s); return NULL; }
+     }
  
      if (role == 1) {
-         if(!auth_admin(s)){ send_line(s,"Invalid credentials\n"); close(s); return NULL; }
+         int a = auth_admin(s);
+         if(a<=0){ if(!a) send_line(s,"Invalid credentials\n"); io_close(s); return NULL; }
          send_line(s,"[OK] Admin authenticated\n");
          admin_menu(s);
      }
      else if (role == 2) {
          char who[64]="";
-         if(!auth_file(s,FACULTY_FILE,who)){ send_line(s,"Invalid\n"); close(s); return NULL; }
+         int a = auth_file(s,FACULTY_FILE,"faculty",who);
+         if(a<=0){ if(!a) send_line(s,"Invalid\n"); io_close(s); return NULL; }
          send_line(s,"[OK] Faculty authenticated\n");
          faculty_menu(s,who);
      }
      else if (role == 3) {
          char who[64]="";
-         if(!auth_file(s,STUDENT_FILE,who)){ send_line(s,"Invalid\n"); close(s); return NULL; }
+         int a = auth_file(s,STUDENT_FILE,"student",who);
+         if(a<=0){ if(!a) send_line(s,"Invalid\n"); io_close(s); return NULL; }
          send_line(s,"[OK] Student authenticated\n");
          student_menu(s,who);
      }
      else send_line(s,"Bad choice\n");
  
      send_line(s,"Goodbye!\n");
-     close(s);
+     io_close(s);
      return NULL;
  }
  
@@ -249,12 +618,14 @@
          "6. Block Student    (username)\n"
          "7. Set Student Password (username,newPwd)\n"
          "8. Set Faculty Password (username,newPwd)\n"
-         "9. Logout\nChoice:\n";
+         "9. Throttle Counters\n"
+         "10. Logout\nChoice:\n";
  
      for (;;) {
          send_line(s, menu);
          int c = recv_choice(s);
          if (c == -1) return;
+         if ((c==1 || c==3 || (c>=5 && c<=8)) && throttled(s,"admin","admin")) continue;
          if      (c==1) admin_add(s,STUDENT_FILE,"Student");
          else if (c==2) admin_view(s,STUDENT_FILE,"Student");
          else if (c==3) admin_add(s,FACULTY_FILE,"Faculty");
@@ -263,7 +634,8 @@
          else if (c==6) admin_toggle(s,0);
          else if (c==7) admin_setpwd(s,STUDENT_FILE);
          else if (c==8) admin_setpwd(s,FACULTY_FILE);
-         else if (c==9) return;
+         else if (c==9) admin_throttle_stats(s);
+         else if (c==10) return;
          else send_line(s,"Invalid choice\n");
      }
  }
@@ -276,7 +648,7 @@
      send_line(s,"Password:\n"); if(recv_line(s,p,sizeof p)<=0)return;
      u[strcspn(u,"\r\n")] = p[strcspn(p,"\r\n")] = '\0';
  
-     File f; load(file,&f,F_WRLCK);
+     File f; load_key(file,u,&f,F_WRLCK);
  
      int row = find_row(&f, u, 0);
      if (row != -1) {                         /* username exists */
@@ -291,30 +663,33 @@
  
      /* append (or overwrite malformed entry) */
      if (row == -1) {                         /* append */
+         lseek(f.fd,0,SEEK_END);              /* io_read_at() keeps offset 0 */
          dprintf(f.fd,"%s|%s|1|\n",u,p);
-     } else {                                 /* overwrite */
+         release(&f);
+     } else {                                 /* overwrite (save closes) */
          char newline[MAX_LINE];
          snprintf(newline,sizeof newline,"%s|%s|1|",u,p);
          f.ln[row] = strdup(newline);
          save(&f);
      }
-     release(&f);
      send_line(s,"[OK] Added\n");
  }
  
  static void admin_view(int s,const char *file,const char *title)
  {
-     File f; if(load(file,&f,F_RDLCK)<0){ send_line(s,"Error\n"); return; }
-     char hdr[64]; snprintf(hdr,sizeof hdr,"\n%s List\n",title); send_line(s,hdr);
-     for(int i=0;i<f.n;i++){
-         if(is_skip_line(f.ln[i])) continue;
-         char *fld[4]; int k = split_line(f.ln[i], fld);
+     File *f = load_all(file); if(!f){ send_line(s,"Error\n"); return; }
+     Text out = {0};
+     text_printf(&out,"\n%s List\n",title);
+     for(int sh=0;sh<nshards;sh++)
+     for(int i=0;i<f[sh].n;i++){
+         if(is_skip_line(f[sh].ln[i])) continue;
+         char *fld[4]; int k = split_line(f[sh].ln[i], fld);
          if(k<3) continue;
-         char ln[128]; snprintf(ln,sizeof ln," - %-12s  [%s]\n",
-                                fld[0], fld[2][0]=='1' ? "active" : "blocked");
-         send_line(s,ln);
+         text_printf(&out," - %-12s  [%s]\n",
+                     fld[0], fld[2][0]=='1' ? "active" : "blocked");
      }
-     release(&f);
+     release_all(f);
+     text_send(s,&out);
  }
  
  /* activate=1 → activate, 0 → block */
@@ -324,7 +699,7 @@
      send_line(s,"Student username:\n"); if(recv_line(s,u,sizeof u)<=0) return;
      u[strcspn(u,"\r\n")] = '\0';
  
-     File f; load(STUDENT_FILE,&f,F_WRLCK);
+     File f; load_key(STUDENT_FILE,u,&f,F_WRLCK);
      int row = find_row(&f,u,0);
      if(row<0){ release(&f); send_line(s,"User not found\n"); return; }
  
@@ -346,7 +721,7 @@
      send_line(s,"New password:\n"); if(recv_line(s,p,sizeof p)<=0) return;
      u[strcspn(u,"\r\n")] = p[strcspn(p,"\r\n")] = '\0';
  
-     File f; load(file,&f,F_WRLCK);
+     File f; load_key(file,u,&f,F_WRLCK);
      int row = find_row(&f,u,0);
      if(row<0){ release(&f); send_line(s,"User not found\n"); return; }
  
@@ -359,6 +734,18 @@
      send_line(s,"[OK]\n");
  }
  
+ static void admin_throttle_stats(int s)
+ {
+     send_line(s,"\nThrottle events  (burst, refill/min)\n");
+     for (int i = 0; i < RL_NCLASS; ++i) {
+         char ln[128];
+         snprintf(ln,sizeof ln," - %-16s %10llu   (%u, %u)\n", rl_pol[i].name,
+                  (unsigned long long)__atomic_load_n(&rl_hits[i],__ATOMIC_RELAXED),
+                  rl_pol[i].burst, rl_pol[i].per_min);
+         send_line(s,ln);
+     }
+ }
+ 
  /*────────────────────────── FACULTY ──────────────────────────*/
  static void faculty_menu(int s,const char *who)
  {
@@ -374,6 +761,7 @@
          send_line(s,menu);
          int c = recv_choice(s);
          if (c == -1) return;
+         if ((c==1 || c==2 || c==4) && throttled(s,"faculty",who)) continue;
          if      (c==1) faculty_add_course(s,who);
          else if (c==2) faculty_remove_course(s,who);
          else if (c==3) faculty_view_enrollments(s,who);
@@ -394,7 +782,7 @@
      int limit = atoi(lim);
  
      /*---- catalogue ------------------------------------------------*/
-     File fc; load(COURSE_FILE,&fc,F_WRLCK);
+     File fc; load_key(COURSE_FILE,id,&fc,F_WRLCK);
      int row = find_row(&fc,id,0);
      if(row<0){                                   /* new course */
          fc.ln = realloc(fc.ln,(fc.n+1)*sizeof(char*));
@@ -402,10 +790,11 @@
          sprintf(line,"%s|%s|%d|0",id,name,limit);
          fc.ln[fc.n++] = line;
      }
+     if(row<0) catalog_invalidate();
      save(&fc);
  
      /*---- add course to professor row ------------------------------*/
-     File ff; load(FACULTY_FILE,&ff,F_WRLCK);
+     File ff; load_key(FACULTY_FILE,who,&ff,F_WRLCK);
      int prow = find_row(&ff,who,0);
      if(prow>=0){
          char *fld[4]; int k = split_line(ff.ln[prow], fld);
@@ -432,31 +821,24 @@
      cid[strcspn(cid,"\r\n")] = '\0';
  
      /*---- remove from catalogue ------------------------------------*/
-     File fc; load(COURSE_FILE,&fc,F_WRLCK);
+     File fc; load_key(COURSE_FILE,cid,&fc,F_WRLCK);
      int found = find_row(&fc,cid,0);
      if(found<0){ release(&fc); send_line(s,"Course not found\n"); return;}
  
      /* do NOT free the pointer (may belong to fc.buf) - just shift   */
      memmove(&fc.ln[found], &fc.ln[found+1], (fc.n-found-1)*sizeof(char*));
      fc.n--;
+     catalog_invalidate();
      save(&fc);
  
      /*---- remove from professor row --------------------------------*/
-     File ff; load(FACULTY_FILE,&ff,F_WRLCK);
+     File ff; load_key(FACULTY_FILE,who,&ff,F_WRLCK);
      int prow = find_row(&ff,who,0);
      if(prow>=0){
          char *fld[4]; int k = split_line(ff.ln[prow], fld);
          if(k==4 && fld[2][0]=='1'){
-             char newlist[MAX_LIST]=""; int first=1;
-             char *sub,*sv;
-             sub = strtok_r(fld[3],",",&sv);
-             while(sub){
-                 if(strcmp(sub,cid)){
-                     if(!first) strcat(newlist,",");
-                     strcat(newlist,sub); first=0;
-                 }
-                 sub = strtok_r(NULL,",",&sv);
-             }
+             char newlist[MAX_LIST];
+             list_remove(fld[3],cid,newlist);
              char newline[MAX_LINE];
              snprintf(newline,sizeof newline,"%s|%s|%s|%s",
                       fld[0],fld[1],fld[2],newlist);
@@ -471,7 +853,7 @@
  {
      /* get professor's course list */
      char offered[MAX_LIST]="";
-     File ff; load(FACULTY_FILE,&ff,F_RDLCK);
+     File ff; load_key(FACULTY_FILE,who,&ff,F_RDLCK);
      int prow = find_row(&ff,who,0);
      if(prow>=0){
          char *fld[4]; int k = split_line(ff.ln[prow], fld);
@@ -480,31 +862,32 @@
      release(&ff);
      if(!strlen(offered)){ send_line(s,"You offer no courses (or account blocked)\n"); return;}
  
-     File fs; load(STUDENT_FILE,&fs,F_RDLCK);
+     File *fs = load_all(STUDENT_FILE);
+     if(!fs){ send_line(s,"Error\n"); return; }
  
+     Text out = {0};
      char *cid,*outer;
      cid = strtok_r(offered,",",&outer);
      while(cid){
-         char hdr[64]; snprintf(hdr,sizeof hdr,"\n%s:\n",cid); send_line(s,hdr);
+         text_printf(&out,"\n%s:\n",cid);
  
-         for(int i=0;i<fs.n;i++){
-             if(is_skip_line(fs.ln[i])) continue;
-             char *fld[4]; int k = split_line(fs.ln[i], fld);
+         for(int sh=0;sh<nshards;sh++)
+         for(int i=0;i<fs[sh].n;i++){
+             if(is_skip_line(fs[sh].ln[i])) continue;
+             char *fld[4]; int k = split_line(fs[sh].ln[i], fld);
              if(k<4 || fld[2][0]!='1' || !strlen(fld[3])) continue;
  
              char *sub,*sv;
              sub = strtok_r(fld[3],",",&sv);
              while(sub){
-                 if(!strcmp(sub,cid)){
-                     char line[128]; snprintf(line,sizeof line," - %s\n",fld[0]);
-                     send_line(s,line); break;
-                 }
+                 if(!strcmp(sub,cid)){ text_printf(&out," - %s\n",fld[0]); break; }
                  sub = strtok_r(NULL,",",&sv);
              }
          }
          cid = strtok_r(NULL,",",&outer);
      }
-     release(&fs);
+     release_all(fs);
+     text_send(s,&out);
  }
  
  static void faculty_change_pwd(int s,const char *who)
@@ -513,7 +896,7 @@
      send_line(s,"New password:\n"); if(recv_line(s,pw,sizeof pw)<=0) return;
      pw[strcspn(pw,"\r\n")]='\0';
  
-     File ff; load(FACULTY_FILE,&ff,F_WRLCK);
+     File ff; load_key(FACULTY_FILE,who,&ff,F_WRLCK);
      int prow = find_row(&ff,who,0);
      if(prow>=0){
          char *fld[4]; int k = split_line(ff.ln[prow], fld);
@@ -540,17 +923,20 @@
          "2. Drop Course        (courseID)\n"
          "3. View Enrolled Courses\n"
          "4. Change Password    (newPwd)\n"
-         "5. Logout\nChoice:\n";
+         "5. Browse Catalog\n"
+         "6. Logout\nChoice:\n";
  
      for (;;) {
          send_line(s,menu);
          int c = recv_choice(s);
          if (c == -1) return;
+         if ((c==1 || c==2 || c==4) && throttled(s,"student",who)) continue;
          if      (c==1) student_enroll(s,who);
          else if (c==2) student_unenroll(s,who);
          else if (c==3) student_view(s,who);
          else if (c==4) student_change_pwd(s,who);
-         else if (c==5) return;
+         else if (c==5) student_browse(s);
+         else if (c==6) return;
          else send_line(s,"Invalid choice\n");
      }
  }
@@ -562,7 +948,7 @@
      cid[strcspn(cid,"\r\n")]='\0';
  
      /* bump seats */
-     File fc; load(COURSE_FILE,&fc,F_WRLCK);
+     File fc; load_key(COURSE_FILE,cid,&fc,F_WRLCK);
      int row = find_row(&fc,cid,0);
      if(row<0){ release(&fc); send_line(s,"Course not found\n"); return; }
  
@@ -573,10 +959,11 @@
      char newline[MAX_LINE];
      snprintf(newline,sizeof newline,"%s|%s|%d|%d",fld[0],fld[1],limit,filled);
      fc.ln[row] = strdup(newline);
+     catalog_set(cid,limit-filled);
      save(&fc);
  
      /* add to student record */
-     File fs; load(STUDENT_FILE,&fs,F_WRLCK);
+     File fs; load_key(STUDENT_FILE,user,&fs,F_WRLCK);
      int srow = find_row(&fs,user,0);
      if(srow>=0){
          char *sfld[4]; k = split_line(fs.ln[srow], sfld);
@@ -598,21 +985,12 @@
      cid[strcspn(cid,"\r\n")] = '\0';
  
      /* remove from student list */
-     File fs; load(STUDENT_FILE,&fs,F_WRLCK);
+     File fs; load_key(STUDENT_FILE,user,&fs,F_WRLCK);
      int srow = find_row(&fs,user,0); if(srow<0){ release(&fs); return; }
  
      char *sfld[4]; int k = split_line(fs.ln[srow], sfld);
-     char newlist[MAX_LIST]=""; int first=1, had=0;
-     if(k==4){
-         char *sub,*sv; sub = strtok_r(sfld[3],",",&sv);
-         while(sub){
-             if(strcmp(sub,cid)){
-                 if(!first) strcat(newlist,",");
-                 strcat(newlist,sub); first=0;
-             } else had=1;
-             sub = strtok_r(NULL,",",&sv);
-         }
-     }
+     char newlist[MAX_LIST]=""; int had=0;
+     if(k==4) had = list_remove(sfld[3],cid,newlist);
      if(!had){ release(&fs); send_line(s,"Not enrolled in that course\n"); return; }
  
      char newline[MAX_LINE];
@@ -622,13 +1000,14 @@
      save(&fs);
  
      /* decrement seats */
-     File fc; load(COURSE_FILE,&fc,F_WRLCK);
+     File fc; load_key(COURSE_FILE,cid,&fc,F_WRLCK);
      int row = find_row(&fc,cid,0);
      if(row>=0){
          char *fld[4]; k = split_line(fc.ln[row], fld);
          int filled = atoi(fld[3]); if(filled>0) filled--;
          snprintf(newline,sizeof newline,"%s|%s|%s|%d",fld[0],fld[1],fld[2],filled);
          fc.ln[row] = strdup(newline);
+         catalog_set(cid,atoi(fld[2])-filled);
      }
      save(&fc);
      send_line(s,"[OK] Unenrolled\n");
@@ -636,7 +1015,7 @@
  
  static void student_view(int s,const char *user)
  {
-     File fs; load(STUDENT_FILE,&fs,F_RDLCK);
+     File fs; load_key(STUDENT_FILE,user,&fs,F_RDLCK);
      int srow = find_row(&fs,user,0); if(srow<0){ release(&fs); return; }
  
      char *fld[4]; int k = split_line(fs.ln[srow], fld);
@@ -645,20 +1024,36 @@
  
      if(!strlen(list)){ send_line(s,"No courses enrolled\n"); return;}
  
-     File fc; load(COURSE_FILE,&fc,F_RDLCK);
-     send_line(s,"Enrolled:\n");
-     char *cid,*sv; cid = strtok_r(list,",",&sv);
-     while(cid){
-         int row = find_row(&fc,cid,0);
+     /* load each course shard that holds one of the IDs once, in order */
+     char *cid[MAX_LIST/2], *sv; int sh[MAX_LIST/2], n=0;
+     char want[MAX_SHARDS]={0}, got[MAX_SHARDS]={0};
+     for(char *c = strtok_r(list,",",&sv); c && n < MAX_LIST/2; c = strtok_r(NULL,",",&sv)){
+         cid[n] = c; sh[n] = shard_of(c,nshards); want[sh[n++]] = 1;
+     }
+     File *fc = malloc(nshards * sizeof *fc);
+     for(int i=0;i<nshards;i++)
+         if(want[i] && load_at(COURSE_FILE,i,&fc[i],F_RDLCK)==0) got[i] = 1;
+ 
+     Text out = {0};
+     text_printf(&out,"Enrolled:\n");
+     for(int j=0;j<n;j++){
+         if(!got[sh[j]]) continue;
+         int row = find_row(&fc[sh[j]],cid[j],0);
          if(row>=0){
-             char *fld2[2]; k = split_line(fc.ln[row], fld2);
-             char line[MAX_LINE];
-             snprintf(line,sizeof line," - %s : %s\n",fld2[0],fld2[1]);
-             send_line(s,line);
+             char *fld2[4]; k = split_line(fc[sh[j]].ln[row], fld2);
+             if(k>=2) text_printf(&out," - %s : %s\n",fld2[0],fld2[1]);
          }
-         cid = strtok_r(NULL,",",&sv);
      }
-     release(&fc);
+     for(int i=0;i<nshards;i++) if(got[i]) release(&fc[i]);
+     free(fc);
+     text_send(s,&out);
+ }
+ 
+ static void student_browse(int s)
+ {
+     char *txt = catalog_copy();
+     send_line(s, txt ? txt : "Error\n");
+     free(txt);
  }
  
  static void student_change_pwd(int s,const char *user)
@@ -667,7 +1062,7 @@
      send_line(s,"New password:\n"); if(recv_line(s,pw,sizeof pw)<=0) return;
      pw[strcspn(pw,"\r\n")] = '\0';
  
-     File fs; load(STUDENT_FILE,&fs,F_WRLCK);
+     File fs; load_key(STUDENT_FILE,user,&fs,F_WRLCK);
      int row = find_row(&fs,user,0);
      if(row>=0){
          char *fld[4]; int k = split_line(fs.ln[row], fld);
@@ -0,0 +1,49 @@
+#include "shard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* "N G"; a bare "N" (written before generations existed) means G = 0 */
+int shard_load_conf(int *gen){
+    FILE *fp = fopen(SHARD_CONF, "r");
+    int n = 1, g = 0;
+    if (fp){
+        int k = fscanf(fp, "%d %d", &n, &g);
+        if (k < 1) n = 1;
+        if (k < 2) g = 0;
+        fclose(fp);
+    }
+    if (n < 1) n = 1;
+    if (n > MAX_SHARDS) n = MAX_SHARDS;
+    if (g < 0) g = 0;
+    if (gen) *gen = g;
+    return n;
+}
+
+/* synced to disk and renamed into place: this is the layout switch */
+int shard_save_conf(int n, int gen){
+    char tmp[256];
+    snprintf(tmp, sizeof tmp, "%s.tmp", SHARD_CONF);
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) return -1;
+    fprintf(fp, "%d %d\n", n, gen);
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0){ fclose(fp); return -1; }
+    if (fclose(fp) != 0) return -1;
+    return rename(tmp, SHARD_CONF);
+}
+
+/* FNV-1a over the key field — must never change without a reshard */
+int shard_of(const char *key, int n){
+    unsigned h = 2166136261u;
+    for (; *key && *key != '|'; ++key){
+        h ^= (unsigned char)*key;
+        h *= 16777619u;
+    }
+    return n > 1 ? (int)(h % (unsigned)n) : 0;
+}
+
+void shard_path(const char *base, int i, int n, int gen, char *out, size_t sz){
+    if (gen > 0)     snprintf(out, sz, "%s.g%d.%d", base, gen, i);
+    else if (n <= 1) snprintf(out, sz, "%s", base);
+    else             snprintf(out, sz, "%s.%d", base, i);
+}
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "io_engine.h"
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <string.h>
@@ -7,14 +8,14 @@
 
 ssize_t send_line(int sockfd, const char *buf){
     size_t len = strlen(buf);
-    return send(sockfd, buf, len, 0);
+    return io_send(sockfd, buf, len);
 }
 
 ssize_t recv_line(int sockfd, char *buf, size_t maxlen){
     ssize_t n, rc;
     char c;
     for (n = 0; n < maxlen-1; ){
-        if ((rc = recv(sockfd, &c, 1, 0)) == 1){
+        if ((rc = io_recv(sockfd, &c, 1)) == 1){
             buf[n++] = c;
             if (c=='\n') break;
         } else if(rc==0){